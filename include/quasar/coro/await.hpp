@@ -48,8 +48,13 @@ QUASAR_CORO_EXPORT namespace quasar::coro::await {
 		constexpr bool await_ready() const noexcept { return !task; }
 
 		constexpr std::coroutine_handle<void> await_suspend(std::coroutine_handle<void> caller) const noexcept {
-			if constexpr(Destructive){ caller.destroy(); }
-			return task;
+			if constexpr(Destructive){
+				// this awaiter lives in the caller's frame, so it must not be read after destroying it
+				auto next = task;
+				caller.destroy();
+				return next;
+			}
+			else { return task; }
 		}
 
 		constexpr void await_resume() const noexcept {}
@@ -87,6 +92,36 @@ QUASAR_CORO_EXPORT namespace quasar::coro::await {
 			std::optional<std::tuple<Ts...>> m_results = std::nullopt;
 	};
 
+	/* asks the promise (see `promise::budgeted`) to reschedule the awaiting coroutine if its time slice is used up */
+	struct yield_if_budget_exhausted {
+		constexpr bool await_ready() const noexcept { return false; }
+
+		template<class Promise> bool await_suspend(std::coroutine_handle<Promise> caller){
+			// a requeued generator would also hand control back to its consumer, which would then resume it a second time
+			static_assert(
+				!requires{ caller.promise().get_value(); },
+				"generators cannot be rescheduled; place the budget checkpoints in the consuming coroutine instead"
+			);
+
+			// set up before rescheduling, since the caller may be resumed on another thread before this returns
+			m_task = caller;
+			m_begin_slice = [](std::coroutine_handle<void> task) noexcept {
+				std::coroutine_handle<Promise>::from_address(task.address()).promise().begin_slice();
+			};
+
+			if(caller.promise().reschedule_if_exhausted(caller)){ return true; }
+			m_begin_slice = nullptr;
+			return false;
+		}
+
+		/* a new slice starts when the rescheduled coroutine is actually resumed, not when it was queued */
+		void await_resume() const noexcept { if(m_begin_slice){ m_begin_slice(m_task); } }
+
+		private:
+			std::coroutine_handle<void> m_task = nullptr;
+			void (*m_begin_slice)(std::coroutine_handle<void>) noexcept = nullptr;
+	};
+
 	template<class T> struct fetch {
 		T value;
 
@@ -35,14 +35,17 @@ QUASAR_CORO_EXPORT namespace quasar::coro::await {
 
 			++m_count;
 			coro.promise().set_continuation(handler(coro));
-			if constexpr(requires { coro.release(); }){ return coro.release().resume(); }
-			else { return coro.resume(); }
+			// resumed through a plain handle: the frame is already destroyed by `handler` if it completes synchronously
+			if constexpr(requires { coro.release(); }){ return std::coroutine_handle<void>{coro.release()}.resume(); }
+			else { return std::coroutine_handle<void>{coro}.resume(); }
 		}
 
 		private:
 			coroutine<task_promise<void>> handler(std::coroutine_handle<void> coro){
 				if(coro){ coro.destroy(); }
-				co_await await::handoff<true>{.task = --m_count? nullptr : m_continuation};
+				// always hand off, even with nothing to resume, so that this frame is destroyed rather than left paused
+				std::coroutine_handle<void> next = --m_count? nullptr : m_continuation;
+				co_await await::handoff<true>{.task = next? next : std::noop_coroutine()};
 			}
 
 			std::size_t m_count = 0;
@@ -69,7 +69,7 @@ QUASAR_CORO_EXPORT namespace quasar::coro {
 
 		[[nodiscard]] constexpr auto release() noexcept { return std::exchange<coroutine<Promise>>(*this, nullptr); }
 
-		coroutine<Promise> get() const noexcept { return *this; }
+		coroutine<Promise> get() const noexcept { return static_cast<coroutine<Promise> const&>(*this); }
 	};
 
 	using procedure = coroutine<procedure_promise>;
@@ -0,0 +1,163 @@
+/**
+ *  Copyright (C) 2025 Ashwin Rajasekar
+ *
+ *  This file is a part of quasar-coro.
+ *
+ *  quasar-coro is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser Public License version 3 as published by the
+ *  Free Software Foundation.
+ *
+ *  quasar-coro is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License & the GNU
+ *  Lesser Public License along with this software; see the files COPYING and
+ *  COPYING.LESSER respectively.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iomanip>
+#include <new>
+#include <ostream>
+#include <source_location>
+#include <string_view>
+#include <vector>
+
+namespace quasar::coro::promise::detail {
+	struct frame_counters {
+		explicit frame_counters(std::string_view label) noexcept : name{label}{}
+
+		void allocated(std::size_t size) noexcept {
+			if(!linked.load(std::memory_order_relaxed) && !linked.exchange(true, std::memory_order_relaxed)){ link(); }
+			allocations.fetch_add(1, std::memory_order_relaxed);
+			live.fetch_add(1, std::memory_order_relaxed);
+			update_max(largest_frame, size);
+			update_max(peak_live_bytes, live_bytes.fetch_add(size, std::memory_order_relaxed) + size);
+		}
+
+		void deallocated(std::size_t size) noexcept {
+			live.fetch_sub(1, std::memory_order_relaxed);
+			live_bytes.fetch_sub(size, std::memory_order_relaxed);
+		}
+
+		void link() noexcept {
+			next = registry.load(std::memory_order_relaxed);
+			while(!registry.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed)){}
+		}
+
+		static void update_max(std::atomic<std::size_t>& peak, std::size_t value) noexcept {
+			auto current = peak.load(std::memory_order_relaxed);
+			while(current < value && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)){}
+		}
+
+		/* every instrumented promise type links its counters here on its first allocation; nodes are never removed */
+		static inline std::atomic<frame_counters*> registry = nullptr;
+
+		std::string_view name;
+		frame_counters* next = nullptr;
+		std::atomic<std::size_t> allocations = 0;
+		std::atomic<std::size_t> live = 0;
+		std::atomic<std::size_t> live_bytes = 0;
+		std::atomic<std::size_t> peak_live_bytes = 0;
+		std::atomic<std::size_t> largest_frame = 0;
+		std::atomic<bool> linked = false;
+	};
+
+	template<class T> constexpr std::string_view type_name() noexcept {
+		std::string_view name = std::source_location::current().function_name();
+		// GCC & Clang spell the argument as "[with T = ...]" / "[T = ...]"; other compilers get the whole signature
+		if(auto start = name.find("T = "); start != name.npos){
+			name.remove_prefix(start + 4);
+			return name.substr(0, name.find_first_of(";]"));
+		}
+		return name;
+	}
+}
+
+QUASAR_CORO_EXPORT namespace quasar::coro::promise {
+	/** Allocation Support **/
+	template<class Promise> struct profiled {
+		/* both kept out of line so that GCC pairs them with each other rather than the global ones (-Wmismatched-new-delete) */
+		[[gnu::noinline]] static void* operator new(std::size_t size){
+			void* frame = ::operator new(size);
+			profile_counters().allocated(size);
+			return frame;
+		}
+
+		[[gnu::noinline]] static void operator delete(void* frame, std::size_t size) noexcept {
+			profile_counters().deallocated(size);
+			::operator delete(frame, size);
+		}
+
+		/* promise types may name themselves with a `frame_name` member, e.g. to tell coroutine functions apart */
+		static detail::frame_counters& profile_counters() noexcept {
+			static detail::frame_counters counters{[]{
+				if constexpr(requires{ std::string_view{Promise::frame_name}; }){ return std::string_view{Promise::frame_name}; }
+				else { return detail::type_name<Promise>(); }
+			}()};
+			return counters;
+		}
+	};
+}
+
+QUASAR_CORO_EXPORT namespace quasar::coro {
+	struct frame_stats {
+		std::string_view name;
+		std::size_t allocations;
+		std::size_t live;
+		std::size_t live_bytes;
+		std::size_t peak_live_bytes;
+		std::size_t largest_frame;
+	};
+
+	struct frame_profile {
+		static std::vector<frame_stats> snapshot(){
+			std::vector<frame_stats> stats;
+			for(auto* node = registry(); node; node = node->next){ stats.push_back(read(*node)); }
+			std::sort(stats.begin(), stats.end(), [](auto const& lhs, auto const& rhs){
+				return lhs.peak_live_bytes > rhs.peak_live_bytes;
+			});
+			return stats;
+		}
+
+		/* reading the counters of a promise type which has not allocated yet gives zeros, without listing it in snapshots */
+		template<class Promise> static frame_stats of() noexcept { return read(promise::profiled<Promise>::profile_counters()); }
+
+		/* writes one row per instrumented promise type, largest peak resident frame memory first */
+		static void dump(std::ostream& out){
+			out << std::left << std::setw(48) << "promise" << std::right
+				<< std::setw(12) << "allocs" << std::setw(10) << "live"
+				<< std::setw(14) << "live bytes" << std::setw(14) << "peak bytes" << std::setw(12) << "max frame" << '\n';
+
+			for(auto const& row : snapshot()){
+				out << std::left << std::setw(48) << row.name << std::right
+					<< std::setw(12) << row.allocations << std::setw(10) << row.live
+					<< std::setw(14) << row.live_bytes << std::setw(14) << row.peak_live_bytes
+					<< std::setw(12) << row.largest_frame << '\n';
+			}
+		}
+
+		private:
+			static promise::detail::frame_counters* registry() noexcept {
+				return promise::detail::frame_counters::registry.load(std::memory_order_acquire);
+			}
+
+			static frame_stats read(promise::detail::frame_counters const& node) noexcept {
+				return {
+					node.name,
+					node.allocations.load(std::memory_order_relaxed),
+					node.live.load(std::memory_order_relaxed),
+					node.live_bytes.load(std::memory_order_relaxed),
+					node.peak_live_bytes.load(std::memory_order_relaxed),
+					node.largest_frame.load(std::memory_order_relaxed)
+				};
+			}
+	};
+}
@@ -21,10 +21,22 @@
 
 #include "await.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
 #include <optional>
 #include <type_traits>
 
+#ifdef QUASAR_CORO_PROFILE_FRAMES
+#include "profile.hpp"
+#endif
+
 /** Some functions are either static or explicit-object depending on if the feature is available
  *    if explicit-object functions are not available, the promise class must define the necessary member fuction for the
  *    coroutine machinery, using the static base-class function as a default implementation */
@@ -53,6 +65,8 @@ namespace quasar::coro::promise::detail {
 
 		T& get() noexcept { return *m_value; }
 
+		T const& get() const noexcept { return *m_value; }
+
 		private:
 			std::conditional_t<
 				ref_type,
@@ -60,6 +74,20 @@ namespace quasar::coro::promise::detail {
 				std::optional<T>
 			> m_value = {};
 	};
+
+	/* the common promise types are instrumented by `promise::profiled` when frame profiling is enabled
+	 *   otherwise this base is empty, leaving allocation entirely to the derived promise or the global functions */
+	#ifdef QUASAR_CORO_PROFILE_FRAMES
+	template<class Promise> struct default_allocation : profiled<Promise> {};
+
+	#else
+	template<class Promise> struct default_allocation {};
+
+	#endif
+}
+
+QUASAR_CORO_EXPORT namespace quasar::coro {
+	template<class T> struct basic_yield_iterator;
 }
 
 QUASAR_CORO_EXPORT namespace quasar::coro::promise {
@@ -100,6 +128,16 @@ QUASAR_CORO_EXPORT namespace quasar::coro::promise {
 			std::exception_ptr m_except = nullptr;
 	};
 
+	/* unlike `unwind_on_exception`, the exception is kept so that every observer of the result can rethrow it */
+	struct shared_exception {
+		void unhandled_exception() noexcept { m_except = std::current_exception(); }
+
+		void rethrow() const { if(m_except){ std::rethrow_exception(m_except); } }
+
+		protected:
+			std::exception_ptr m_except = nullptr;
+	};
+
 
 
 
@@ -148,13 +186,22 @@ QUASAR_CORO_EXPORT namespace quasar::coro::promise {
 
 	template<class T> requires (std::is_void_v<T>) struct result<T> { void return_void(){} };
 
+	template<class Result> struct shared_result {
+		template<class T> void return_value(T&& arg){ m_result.capture_value(std::forward<T>(arg)); }
+
+		Result const& get_result() const noexcept { return m_result.get(); }
+
+		protected:
+			detail::capture<Result> m_result = {};
+	};
+
+	template<class T> requires (std::is_void_v<T>) struct shared_result<T> { void return_void(){} };
 
 
 
 
-	/** Yield Support **/
-	template<class> struct yield_iterator;
 
+	/** Yield Support **/
 	template<class Yield, bool async = false> struct yield {
 		template<class T = Yield>
 		QUASAR_CORO_EO_STATIC auto yield_value(QUASAR_CORO_EO_THIS auto& self, T&& value) noexcept {
@@ -169,7 +216,7 @@ QUASAR_CORO_EXPORT namespace quasar::coro::promise {
 			detail::capture<Yield> m_yield = {};
 	};
 
-	template<class Yield, class Base = yield<Yield>, class YieldItr = yield_iterator<Yield>>
+	template<class Yield, class Base = yield<Yield>, class YieldItr = basic_yield_iterator<Yield>>
 	struct delegating_yield : Base {
 		using Base::Base;
 		using Base::yield_value;
@@ -187,6 +234,89 @@ QUASAR_CORO_EXPORT namespace quasar::coro::promise {
 		protected:
 			YieldItr* m_iterator = nullptr;
 	};
+
+
+
+
+
+	/** Budget Support **/
+	template<class Clock = std::chrono::steady_clock> struct budgeted {
+		using duration = typename Clock::duration;
+
+		struct accounting {
+			std::size_t checkpoints = 0;          // budget checks made over the lifetime of the coroutine
+			std::size_t slices = 0;               // slices used up, i.e. times the coroutine was due to be rescheduled
+			duration elapsed = duration::zero();  // time spent in used-up slices; only measured with a time budget
+		};
+
+		/* a slice ends at the checkpoint where either limit is reached; the clock is only read with a time budget */
+		void set_budget(std::size_t checkpoints, duration time = duration::max()) noexcept {
+			m_checkpoint_budget = checkpoints;
+			m_time_budget = time;
+		}
+
+		/* `executor` is invoked with the coroutine handle to requeue it & must outlive the coroutine */
+		template<class Executor> void schedule_on(Executor& executor) noexcept {
+			m_executor = static_cast<void*>(std::addressof(executor));
+			m_schedule = [](void* exec, std::coroutine_handle<void> task){ std::invoke(*static_cast<Executor*>(exec), task); };
+		}
+
+		accounting const& usage() const noexcept { return m_usage; }
+
+		/** Budgeted coroutines start lazily, so that the first slice is measured from their first resumption
+		 *    promises also inheriting another initialization base must re-declare this one with `using` */
+		auto initial_suspend() noexcept {
+			struct starter {
+				budgeted& self;
+
+				constexpr bool await_ready() const noexcept { return false; }
+
+				constexpr void await_suspend(std::coroutine_handle<void>) const noexcept {}
+
+				void await_resume() const noexcept { self.begin_slice(); }
+			};
+
+			return starter{*this};
+		}
+
+		/* called whenever the coroutine is resumed at the start of a new slice */
+		void begin_slice() noexcept {
+			m_slice_checkpoints = 0;
+			if(m_time_budget != duration::max()){ m_slice_start = Clock::now(); }
+		}
+
+		/* returns whether `task` was handed to the executor; without one the slice is accounted for & it keeps running */
+		bool reschedule_if_exhausted(std::coroutine_handle<void> task){
+			++m_usage.checkpoints;
+
+			bool const timed = m_time_budget != duration::max();
+			auto const now = timed? Clock::now() : typename Clock::time_point{};
+
+			if(++m_slice_checkpoints < m_checkpoint_budget && (!timed || now - m_slice_start < m_time_budget)){ return false; }
+
+			++m_usage.slices;
+			m_usage.elapsed += now - m_slice_start;
+
+			if(!m_schedule){
+				begin_slice();
+				return false;
+			}
+			// the executor may resume the task on another thread right away, so the promise must not be touched after this
+			m_schedule(m_executor, task);
+			return true;
+		}
+
+		private:
+			std::size_t m_checkpoint_budget = std::numeric_limits<std::size_t>::max();
+			duration m_time_budget = duration::max();
+
+			void (*m_schedule)(void*, std::coroutine_handle<void>) = nullptr;
+			void* m_executor = nullptr;
+
+			std::size_t m_slice_checkpoints = 0;
+			typename Clock::time_point m_slice_start{};
+			accounting m_usage{};
+	};
 }
 
 /** Common Promise Implementations **/
@@ -196,7 +326,8 @@ QUASAR_CORO_EXPORT namespace quasar::coro {
 		promise::eager,
 		promise::nothrow,
 		promise::destroy_on_finish,
-		promise::result<void>
+		promise::result<void>,
+		promise::detail::default_allocation<procedure_promise>
 	{
 		#ifdef QUASAR_CORO_NO_EXPLICIT_OBJECT
 		auto get_return_object(){ return promise::base::get_return_object(*this); }
@@ -208,7 +339,8 @@ QUASAR_CORO_EXPORT namespace quasar::coro {
 		promise::lazy,
 		promise::unwind_on_exception,
 		promise::delegatable<true>,
-		promise::result<Result>
+		promise::result<Result>,
+		promise::detail::default_allocation<task_promise<Result>>
 	{
 		#ifdef QUASAR_CORO_NO_EXPLICIT_OBJECT
 		auto get_return_object(){ return promise::base::get_return_object(*this); }
@@ -217,8 +349,14 @@ QUASAR_CORO_EXPORT namespace quasar::coro {
 
 	template<class Yield, class Result> struct simple_generator_promise :
 		task_promise<Result>,
-		promise::yield<Yield>
+		promise::yield<Yield>,
+		promise::detail::default_allocation<simple_generator_promise<Yield, Result>>
 	{
+		#ifdef QUASAR_CORO_PROFILE_FRAMES
+		using promise::detail::default_allocation<simple_generator_promise>::operator new;
+		using promise::detail::default_allocation<simple_generator_promise>::operator delete;
+		#endif
+
 		#ifdef QUASAR_CORO_NO_EXPLICIT_OBJECT
 		auto get_return_object(){ return promise::base::get_return_object(*this); }
 
@@ -229,8 +367,14 @@ QUASAR_CORO_EXPORT namespace quasar::coro {
 
 	template<class Yield, class Result> struct generator_promise :
 		task_promise<Result>,
-		promise::delegating_yield<Yield>
+		promise::delegating_yield<Yield>,
+		promise::detail::default_allocation<generator_promise<Yield, Result>>
 	{
+		#ifdef QUASAR_CORO_PROFILE_FRAMES
+		using promise::detail::default_allocation<generator_promise>::operator new;
+		using promise::detail::default_allocation<generator_promise>::operator delete;
+		#endif
+
 		#ifdef QUASAR_CORO_NO_EXPLICIT_OBJECT
 		auto get_return_object(){ return promise::base::get_return_object(*this); }
 
@@ -238,6 +382,87 @@ QUASAR_CORO_EXPORT namespace quasar::coro {
 		auto yield_value(T&& yield){ return promise::delegating_yield<Yield>::yield_value(*this, std::forward<T>(yield)); }
 		#endif
 	};
+
+	template<class Result> struct shared_task_promise :
+		promise::base,
+		promise::lazy,
+		promise::shared_exception,
+		promise::shared_result<Result>,
+		promise::detail::default_allocation<shared_task_promise<Result>>
+	{
+		/** Intrusive node for the list of coroutines awaiting the result
+		 *    nodes live inside the awaiting coroutine frames, so no allocation is needed to register an awaiter */
+		struct waiter {
+			std::coroutine_handle<void> continuation = nullptr;
+			void (*schedule)(void*, std::coroutine_handle<void>) = nullptr;
+			void* executor = nullptr;
+			waiter* next = nullptr;
+		};
+
+		struct finisher {
+			constexpr bool await_ready() const noexcept { return false; }
+
+			std::coroutine_handle<void> await_suspend(std::coroutine_handle<shared_task_promise> task) const noexcept {
+				auto& self = task.promise();
+				auto* list = static_cast<waiter*>(self.m_waiters.exchange(self.ready_state(), std::memory_order_acq_rel));
+
+				// any resumed waiter may release the last reference to this frame, so only locals are used from here on
+				std::coroutine_handle<void> pending = std::noop_coroutine();
+				while(list){
+					auto* next = list->next;
+					if(list->schedule){ list->schedule(list->executor, list->continuation); }
+					else { std::exchange(pending, list->continuation).resume(); }
+					list = next;
+				}
+				return pending;
+			}
+
+			constexpr void await_resume() const noexcept {}
+		};
+
+		#ifdef QUASAR_CORO_NO_EXPLICIT_OBJECT
+		auto get_return_object(){ return promise::base::get_return_object(*this); }
+		#endif
+
+		finisher final_suspend() const noexcept { return {}; }
+
+		bool ready() const noexcept { return m_waiters.load(std::memory_order_acquire) == ready_state(); }
+
+		/* returns the coroutine to transfer control to after registering the waiter */
+		std::coroutine_handle<void> add_waiter(waiter& node) noexcept {
+			void* state = m_waiters.load(std::memory_order_acquire);
+
+			// the first awaiter starts the task; a strong exchange cannot fail unless another awaiter got there first
+			if(state == not_started_state() && m_waiters.compare_exchange_strong(
+				state, &node, std::memory_order_acq_rel, std::memory_order_acquire
+			)){
+				return std::coroutine_handle<shared_task_promise>::from_promise(*this);
+			}
+
+			do {
+				if(state == ready_state()){
+					if(!node.schedule){ return node.continuation; }
+					node.schedule(node.executor, node.continuation);
+					return std::noop_coroutine();
+				}
+				node.next = static_cast<waiter*>(state);
+			} while(!m_waiters.compare_exchange_weak(state, &node, std::memory_order_release, std::memory_order_acquire));
+
+			return std::noop_coroutine();
+		}
+
+		void acquire() noexcept { m_references.fetch_add(1, std::memory_order_relaxed); }
+
+		[[nodiscard]] bool release() noexcept { return m_references.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+		private:
+			/* the state markers only need to be distinct non-null addresses; null means started with no waiters */
+			void* not_started_state() const noexcept { return const_cast<std::atomic<void*>*>(&m_waiters); }
+			void* ready_state() const noexcept { return const_cast<std::atomic<std::uint32_t>*>(&m_references); }
+
+			std::atomic<std::uint32_t> m_references = 1;
+			std::atomic<void*> m_waiters = not_started_state();
+	};
 }
 
 #undef QUASAR_CORO_EO_STATIC
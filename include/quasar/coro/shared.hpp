@@ -0,0 +1,92 @@
+/**
+ *  Copyright (C) 2025 Ashwin Rajasekar
+ *
+ *  This file is a part of quasar-coro.
+ *
+ *  quasar-coro is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser Public License version 3 as published by the
+ *  Free Software Foundation.
+ *
+ *  quasar-coro is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License & the GNU
+ *  Lesser Public License along with this software; see the files COPYING and
+ *  COPYING.LESSER respectively.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+
+#pragma once
+
+#include "coroutine.hpp"
+#include "promise.hpp"
+
+#include <coroutine>
+#include <functional>
+#include <utility>
+
+QUASAR_CORO_EXPORT namespace quasar::coro {
+	template<class Result> struct shared_task {
+		using promise_type = shared_task_promise<Result>;
+		using handle = std::coroutine_handle<promise_type>;
+
+		struct awaiter : promise_type::waiter {
+			handle task;
+
+			using schedule_func = void(void*, std::coroutine_handle<void>);
+
+			constexpr awaiter(handle coro, schedule_func* schedule = nullptr, void* executor = nullptr) noexcept :
+				promise_type::waiter{.schedule = schedule, .executor = executor},
+				task{coro}{}
+
+			// with an executor, even a completed task resumes the awaiter through it
+			bool await_ready() const noexcept { return !this->schedule && task.promise().ready(); }
+
+			std::coroutine_handle<void> await_suspend(std::coroutine_handle<void> caller) noexcept {
+				this->continuation = caller;
+				return task.promise().add_waiter(*this);
+			}
+
+			decltype(auto) await_resume() const {
+				task.promise().rethrow();
+				if constexpr(requires{ task.promise().get_result(); }){ return task.promise().get_result(); }
+			}
+		};
+
+		constexpr shared_task() noexcept = default;
+		constexpr shared_task(handle coro) noexcept : m_task{coro}{}
+
+		shared_task(shared_task const& other) noexcept : m_task{other.m_task}{ if(m_task){ m_task.promise().acquire(); } }
+		constexpr shared_task(shared_task&& other) noexcept : m_task{std::exchange(other.m_task, nullptr)}{}
+
+		shared_task& operator =(shared_task other) noexcept {
+			std::swap(m_task, other.m_task);
+			return *this;
+		}
+
+		~shared_task() noexcept {
+			if(m_task && m_task.promise().release()){ m_task.destroy(); }
+		}
+
+		explicit operator bool() const noexcept { return !!m_task; }
+
+		/* an empty task has nothing left to produce */
+		bool done() const noexcept { return !m_task || m_task.promise().ready(); }
+
+		awaiter operator co_await() const noexcept { return {m_task}; }
+
+		/* resumes the awaiting coroutine by invoking `executor` with its handle rather than inline on completion */
+		template<class Executor> awaiter via(Executor& executor) const noexcept {
+			return {
+				m_task,
+				[](void* exec, std::coroutine_handle<void> task){ std::invoke(*static_cast<Executor*>(exec), task); },
+				static_cast<void*>(std::addressof(executor))
+			};
+		}
+
+		private:
+			handle m_task = nullptr;
+	};
+}
@@ -0,0 +1,161 @@
+/**
+ *  Copyright (C) 2025 Ashwin Rajasekar
+ *
+ *  This file is a part of quasar-coro.
+ *
+ *  quasar-coro is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser Public License version 3 as published by the
+ *  Free Software Foundation.
+ *
+ *  quasar-coro is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License & the GNU
+ *  Lesser Public License along with this software; see the files COPYING and
+ *  COPYING.LESSER respectively.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+QUASAR_CORO_EXPORT namespace quasar::coro {
+	/** Single-threaded executor with a seeded scheduling order & a virtual clock
+	 *    every posted function & resumed coroutine runs inside `step()`, so a run is fully determined by the seed */
+	struct simulation_executor {
+		enum class policy { fifo, lifo, random };
+
+		using duration = std::chrono::nanoseconds;
+
+		struct sleeper {
+			simulation_executor& executor;
+			duration delay;
+
+			constexpr bool await_ready() const noexcept { return false; }
+
+			void await_suspend(std::coroutine_handle<void> task){ executor.post_after(delay, [task]{ task.resume(); }); }
+
+			constexpr void await_resume() const noexcept {}
+		};
+
+		explicit simulation_executor(std::uint64_t seed = 0, policy order = policy::random) noexcept :
+			m_random{seed},
+			m_order{order}{}
+
+		simulation_executor(simulation_executor const&)  = delete;
+		void operator =(simulation_executor const&)      = delete;
+
+		/* allows the executor to be used anywhere a `void(std::coroutine_handle<void>)` scheduler is expected */
+		void operator ()(std::coroutine_handle<void> task){ post([task]{ task.resume(); }); }
+
+		void post(std::function<void()> func){ m_ready.push_back(std::move(func)); }
+
+		void post_after(duration delay, std::function<void()> func){
+			m_timers.push_back({m_now + std::max(delay, duration::zero()), m_sequence++, std::move(func)});
+			std::push_heap(m_timers.begin(), m_timers.end(), std::greater<>{});
+		}
+
+		/* suspends the awaiting coroutine & places it back among the ready tasks */
+		sleeper schedule() noexcept { return {*this, duration::zero()}; }
+
+		sleeper sleep_for(duration delay) noexcept { return {*this, delay}; }
+
+		duration now() const noexcept { return m_now; }
+
+		std::uint64_t steps() const noexcept { return m_steps; }
+
+		bool idle() const noexcept { return m_ready.empty() && m_timers.empty(); }
+
+		/* runs a single ready function, advancing the clock to the next timer if nothing is ready */
+		bool step(){
+			if(m_ready.empty() && !m_timers.empty()){ m_now = std::max(m_now, m_timers.front().when); }
+			release_timers();
+			if(m_ready.empty()){ return false; }
+
+			auto func = take_ready();
+			++m_steps;
+			func();
+			return true;
+		}
+
+		std::size_t run(){
+			std::size_t count = 0;
+			while(step()){ ++count; }
+			return count;
+		}
+
+		/* runs everything due up to & including `deadline`, then leaves the clock at `deadline` */
+		std::size_t run_until(duration deadline){
+			std::size_t count = 0;
+			while(!m_ready.empty() || (!m_timers.empty() && m_timers.front().when <= deadline)){
+				step();
+				++count;
+			}
+			m_now = std::max(m_now, deadline);
+			return count;
+		}
+
+		std::size_t run_for(duration span){ return run_until(m_now + span); }
+
+		private:
+			struct timer {
+				duration when;
+				std::uint64_t sequence; // breaks ties between timers due at the same instant
+				std::function<void()> func;
+
+				bool operator >(timer const& other) const noexcept {
+					return std::tie(when, sequence) > std::tie(other.when, other.sequence);
+				}
+			};
+
+			void release_timers(){
+				while(!m_timers.empty() && m_timers.front().when <= m_now){
+					std::pop_heap(m_timers.begin(), m_timers.end(), std::greater<>{});
+					m_ready.push_back(std::move(m_timers.back().func));
+					m_timers.pop_back();
+				}
+			}
+
+			std::function<void()> take_ready(){
+				std::function<void()> func;
+				switch(m_order){
+					case policy::fifo:
+						func = std::move(m_ready.front());
+						m_ready.pop_front();
+						return func;
+
+					case policy::random:
+						// plain modulo rather than a distribution, whose output is not specified by the standard
+						std::swap(m_ready[m_random() % m_ready.size()], m_ready.back());
+						[[fallthrough]];
+
+					case policy::lifo:
+						func = std::move(m_ready.back());
+						m_ready.pop_back();
+						return func;
+				}
+				return func;
+			}
+
+			std::deque<std::function<void()>> m_ready{};
+			std::vector<timer> m_timers{};
+			std::mt19937_64 m_random;
+			policy m_order;
+			duration m_now{};
+			std::uint64_t m_sequence = 0;
+			std::uint64_t m_steps = 0;
+	};
+}
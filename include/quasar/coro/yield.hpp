@@ -22,24 +22,45 @@
 #include "coroutine.hpp"
 #include "promise.hpp"
 
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
 #include <iterator>
+#include <stdexcept>
 
-QUASAR_CORO_EXPORT namespace quasar::coro {
-	template<class T> struct yield_iterator {
-		yield_iterator(yield_iterator const&)  = delete;
-		yield_iterator(yield_iterator&&)       = delete;
-		void operator =(yield_iterator const&) = delete;
-		void operator =(yield_iterator&&)      = delete;
+namespace quasar::coro::detail {
+	template<class T> struct saved_binding {
+		std::coroutine_handle<void> task;
+		T (*getter)(std::coroutine_handle<void>) noexcept;
+		void (*rethrow)(std::coroutine_handle<void>);
+		std::coroutine_handle<void> owner;
+		int priority;
+	};
 
-		yield_iterator()  noexcept = default;
-		~yield_iterator() noexcept = default;
+	/* owned producers are checked for completion & then destroyed by the iterator, so they must stay suspended at the end */
+	template<class Promise> concept pauses_at_finish = requires(Promise& promise){
+		requires std::same_as<decltype(promise.final_suspend()), std::suspend_always>
+			|| std::same_as<decltype(promise.final_suspend()), await::handoff<false>>;
+	};
 
-		template<class P> yield_iterator(std::coroutine_handle<P> coro){
-			bind(coro.promise());
-			++*this;
-		}
+	/* kept in a base of `yield_iterator` so that the stack outlives the iterator state referring to it */
+	template<class T, std::size_t PreemptDepth> struct preempt_stack {
+		std::array<saved_binding<T>, PreemptDepth> saved{};
+	};
+}
 
-		bool operator ==(std::default_sentinel_t) const noexcept { return m_task.done(); }
+QUASAR_CORO_EXPORT namespace quasar::coro {
+	/** The part of `yield_iterator` which does not depend on its preemption depth
+	 *    delegating promises keep a pointer to this type, so they can be iterated by a `yield_iterator` of any depth */
+	template<class T> struct basic_yield_iterator {
+		basic_yield_iterator(basic_yield_iterator const&)  = delete;
+		basic_yield_iterator(basic_yield_iterator&&)       = delete;
+		void operator =(basic_yield_iterator const&) = delete;
+		void operator =(basic_yield_iterator&&)      = delete;
+
+		bool operator ==(std::default_sentinel_t) const noexcept { return !m_task || m_task.done(); }
 
 		T operator *() const noexcept { return m_getter(m_task); }
 
@@ -50,9 +71,21 @@ QUASAR_CORO_EXPORT namespace quasar::coro {
 			return std::addressof(tmp);
 		}
 
-		yield_iterator& operator ++(){
-			if(*this != std::default_sentinel){ m_task.resume(); }
-			m_rethrow(m_task);
+		basic_yield_iterator& operator ++(){
+			if(*this != std::default_sentinel){
+				m_task.resume();
+				m_rethrow(m_task);
+			}
+
+			// a finished preemptor hands the stream back to the highest-priority producer still waiting
+			while(m_depth && m_task.done()){
+				if(m_owner){ m_owner.destroy(); }
+				restore(m_saved[--m_depth]);
+				if(!m_task.done()){
+					m_task.resume();
+					m_rethrow(m_task);
+				}
+			}
 			return *this;
 		}
 
@@ -61,7 +94,7 @@ QUASAR_CORO_EXPORT namespace quasar::coro {
 			requires requires { await::delegate<Delegatee>{std::move(task)}; }
 		{
 			struct awaiter : await::delegate<Delegatee> {
-				constexpr awaiter(yield_iterator& itr, DelegaterPromise& caller, Delegatee&& task) noexcept :
+				constexpr awaiter(basic_yield_iterator& itr, DelegaterPromise& caller, Delegatee&& task) noexcept :
 					await::delegate<Delegatee>{std::move(task)},
 					m_iterator{itr},
 					m_promise{caller}{}
@@ -79,51 +112,126 @@ QUASAR_CORO_EXPORT namespace quasar::coro {
 				}
 
 				private:
-					yield_iterator& m_iterator;
+					basic_yield_iterator& m_iterator;
 					DelegaterPromise& m_promise;
 			};
 
 			return awaiter{*this, caller, std::move(task)};
 		}
 
-		template<class Promise> void preempt(std::coroutine_handle<Promise> task){
-			task.promise().set_continuation(
-				[](auto& self, auto preemptor, auto preempted, auto getter, auto rethrow) -> procedure {
-					// this procedure manually handles cleanup since the preemptor is not bound to the lifetime of an object
-					preemptor.destroy();
-					// need to restore & resume the preempted since control has fallen off then end of the preemptor
-					(self.m_task = preempted).resume();
-					// restore the remainder of the yield_iterator to its original state
-					self.m_getter = getter;
-					self.m_rethrow = rethrow;
-
-					co_return;
-				}(*this, task, m_task, m_getter, m_rethrow).release()
-			);
-			bind(task.promise());
+		/** The preempting & submitted coroutines are owned by the iterator once accepted, & destroyed when they finish
+		 *    their values are produced from the next increment onwards; displaced producers are saved in a fixed-size stack
+		 *    so that no allocation takes place, with `std::length_error` thrown once it is full */
+		template<class Promise> requires detail::pauses_at_finish<Promise>
+		void preempt(std::coroutine_handle<Promise> task){ displace(task, m_priority); }
+
+		/* `task` preempts the current producer only if its priority is strictly higher, else it waits its turn */
+		template<class Promise> requires detail::pauses_at_finish<Promise>
+		void submit(std::coroutine_handle<Promise> task, int priority){
+			if(*this == std::default_sentinel){
+				if(m_owner){ m_owner.destroy(); }
+				bind(task.promise());
+				m_owner = task;
+				m_priority = priority;
+			}
+			else if(priority > m_priority){ displace(task, priority); }
+			else { insert(task, priority); }
 		}
 
-		private:
-			template<class Promise> void bind(Promise& promise){
-				static constexpr auto extract_promise = [](std::coroutine_handle<void> task) noexcept -> Promise& {
-					return std::coroutine_handle<Promise>::from_address(task.address()).promise();
-				};
+		protected:
+			basic_yield_iterator(detail::saved_binding<T>* stack, std::size_t capacity) noexcept :
+				m_saved{stack},
+				m_capacity{capacity}{}
+
+			~basic_yield_iterator() noexcept {
+				if(m_owner){ m_owner.destroy(); }
+				for(std::size_t i = 0; i < m_depth; ++i){
+					if(m_saved[i].owner){ m_saved[i].owner.destroy(); }
+				}
+			}
 
+			template<class Promise> void bind(Promise& promise){
 				m_task = std::coroutine_handle<Promise>::from_promise(promise);
-				m_getter = [](std::coroutine_handle<void> task) noexcept -> T { return extract_promise(task).get_value(); };
-				m_rethrow = [](std::coroutine_handle<void> task){
-					if constexpr(requires{ extract_promise(task).rethrow(); }){ return extract_promise(task).rethrow(); }
-				};
+				m_getter = get_value<Promise>;
+				m_rethrow = rethrow<Promise>;
+				link(promise);
+			}
 
+		private:
+			template<class Promise> static Promise& extract_promise(std::coroutine_handle<void> task) noexcept {
+				return std::coroutine_handle<Promise>::from_address(task.address()).promise();
+			}
+
+			template<class Promise> static T get_value(std::coroutine_handle<void> task) noexcept {
+				return extract_promise<Promise>(task).get_value();
+			}
+
+			template<class Promise> static void rethrow(std::coroutine_handle<void> task){
+				if constexpr(requires{ extract_promise<Promise>(task).rethrow(); }){ return extract_promise<Promise>(task).rethrow(); }
+			}
+
+			/* a delegating promise that cannot be linked would later delegate through a null iterator */
+			template<class Promise> void link(Promise& promise){
 				if constexpr(requires{ promise.set_iterator(*this); }){ promise.set_iterator(*this); }
+				else {
+					static_assert(
+						!requires{ &Promise::set_iterator; },
+						"the promise's `set_iterator` does not accept a `basic_yield_iterator` of this value type"
+					);
+				}
 			}
 
-			using getter_func = T(std::coroutine_handle<void>) noexcept;
-			using rethrow_func = void(std::coroutine_handle<void>);
+			void restore(detail::saved_binding<T> const& saved) noexcept {
+				m_task = saved.task;
+				m_getter = saved.getter;
+				m_rethrow = saved.rethrow;
+				m_owner = saved.owner;
+				m_priority = saved.priority;
+			}
+
+			void reserve() const {
+				if(m_depth == m_capacity){ throw std::length_error{"yield_iterator preemption depth exceeded"}; }
+			}
+
+			template<class Promise> void displace(std::coroutine_handle<Promise> task, int priority){
+				reserve();
+				m_saved[m_depth++] = {m_task, m_getter, m_rethrow, m_owner, m_priority};
+				bind(task.promise());
+				m_owner = task;
+				m_priority = priority;
+			}
+
+			/* the stack is ordered by priority with the next to run on top; equal priorities run first-come first-served */
+			template<class Promise> void insert(std::coroutine_handle<Promise> task, int priority){
+				reserve();
+				auto pos = std::lower_bound(m_saved, m_saved + m_depth, priority, [](auto const& saved, int value){
+					return saved.priority < value;
+				});
+				std::move_backward(pos, m_saved + m_depth, m_saved + m_depth + 1);
+				*pos = {task, get_value<Promise>, rethrow<Promise>, task, priority};
+				++m_depth;
+				link(task.promise());
+			}
 
 			std::coroutine_handle<void> m_task{};
-			getter_func* m_getter = nullptr;
-			rethrow_func* m_rethrow = nullptr;
+			T (*m_getter)(std::coroutine_handle<void>) noexcept = nullptr;
+			void (*m_rethrow)(std::coroutine_handle<void>) = nullptr;
+
+			std::coroutine_handle<void> m_owner{};
+			int m_priority = 0;
+			std::size_t m_depth = 0;
+			detail::saved_binding<T>* m_saved;
+			std::size_t m_capacity;
+	};
+
+	template<class T, std::size_t PreemptDepth = 4>
+	struct yield_iterator : private detail::preempt_stack<T, PreemptDepth>, public basic_yield_iterator<T> {
+		yield_iterator() noexcept : basic_yield_iterator<T>{this->saved.data(), PreemptDepth}{}
+
+		template<class P> yield_iterator(std::coroutine_handle<P> coro) : yield_iterator{}{
+			this->bind(coro.promise());
+			++*this;
+		}
 	};
 
 	template<class Generator> struct yield_range {
@@ -132,4 +240,49 @@ QUASAR_CORO_EXPORT namespace quasar::coro {
 		yield_iterator<decltype(task.promise().get_value())> begin() const noexcept { return task; }
 		std::default_sentinel_t end() const noexcept { return {}; }
 	};
+
+	/** Several producers of `T` feeding a single consumer in priority order
+	 *    a producer submitted with a strictly higher priority than the running one preempts it at the next increment */
+	template<class T, std::size_t PreemptDepth = 4> struct priority_stream {
+		struct iterator {
+			using value_type = std::remove_cvref_t<T>;
+			using difference_type = std::ptrdiff_t;
+
+			yield_iterator<T, PreemptDepth>* stream;
+
+			T operator *() const noexcept { return **stream; }
+
+			iterator& operator ++(){
+				++*stream;
+				return *this;
+			}
+
+			void operator ++(int){ ++*this; }
+
+			bool operator ==(std::default_sentinel_t) const noexcept { return *stream == std::default_sentinel; }
+		};
+
+		/* takes ownership of `producer`, unless the stream is full & `std::length_error` is thrown
+		 *   only r-values are accepted, so that a named handle must be explicitly moved into the stream */
+		template<class Generator> requires (
+			!std::is_lvalue_reference_v<Generator>&&
+			detail::pauses_at_finish<typename std::remove_cvref_t<Generator>::promise_type>
+		)
+		void push(Generator&& producer, int priority = 0){
+			if(m_iterator == std::default_sentinel){ m_started = false; }
+			m_iterator.submit(producer.get(), priority);
+			(void)producer.release();
+		}
+
+		iterator begin(){
+			if(!std::exchange(m_started, true)){ ++m_iterator; }
+			return {&m_iterator};
+		}
+
+		std::default_sentinel_t end() const noexcept { return {}; }
+
+		private:
+			yield_iterator<T, PreemptDepth> m_iterator{};
+			bool m_started = false;
+	};
 }
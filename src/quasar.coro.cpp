@@ -19,19 +19,40 @@
 
 module;
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
 #include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <exception>
 #include <functional>
+#include <iomanip>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
 #include <optional>
+#include <ostream>
+#include <random>
+#include <source_location>
+#include <stdexcept>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 export module quasar.coro;
 
+#include "quasar/coro/profile.hpp"
 #include "quasar/coro/await.hpp"
 #include "quasar/coro/coroutine.hpp"
 #include "quasar/coro/promise.hpp"
 #include "quasar/coro/barrier.hpp"
+#include "quasar/coro/shared.hpp"
+#include "quasar/coro/simulation.hpp"
 #include "quasar/coro/yield.hpp"
@@ -0,0 +1,262 @@
+#include <gtest/gtest.h>
+
+#ifndef QUASAR_CORO_MODULES
+	#include <quasar/coro/barrier.hpp>
+	#include <quasar/coro/coroutine.hpp>
+	#include <quasar/coro/shared.hpp>
+	#include <quasar/coro/simulation.hpp>
+	#include <quasar/coro/yield.hpp>
+
+#else
+	#include <chrono>
+	#include <coroutine>
+	import quasar.coro;
+
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace quasar::coro;
+using namespace std::chrono_literals;
+
+namespace {
+	using duration = simulation_executor::duration;
+
+	/* a callback-style API whose completions are delivered by the simulation */
+	void simulated_io(simulation_executor& exec, duration delay, std::function<void(duration)> done){
+		exec.post_after(delay, [&exec, done]{ done(exec.now()); });
+	}
+
+	procedure interleave_worker(simulation_executor& exec, std::vector<int>& trace, int id, int rounds){
+		for(int i = 0; i < rounds; ++i){
+			trace.push_back(id);
+			co_await exec.schedule();
+		}
+	}
+
+	std::vector<int> interleave(std::uint64_t seed){
+		simulation_executor exec{seed};
+		std::vector<int> trace;
+		for(int id = 0; id < 8; ++id){ exec.post([&, id]{ interleave_worker(exec, trace, id, 8); }); }
+		exec.run();
+		return trace;
+	}
+
+	task<void> io_task(simulation_executor& exec, std::vector<int>& completed, int id, duration delay){
+		co_await await::callback<duration>{simulated_io, exec, delay};
+		completed.push_back(id);
+	}
+
+	// only 16 distinct delays, so many completions become ready at once & the policy decides their order
+	duration stress_delay(int i){ return duration{(i * 7919) % 16 + 1}; }
+
+	procedure barrier_stress(simulation_executor& exec, std::vector<int>& completed, duration& finished, int count){
+		await::barrier b{};
+		for(int i = 0; i < count; ++i){ b.wait(io_task(exec, completed, i, stress_delay(i))); }
+		co_await b;
+		finished = exec.now();
+	}
+
+	shared_task<int> backend_fetch(simulation_executor& exec, int& fetches){
+		++fetches;
+		co_await await::callback<duration>{simulated_io, exec, 10ms};
+		co_return 42;
+	}
+
+	template<class Clock = std::chrono::steady_clock>
+	struct budgeted_promise : task_promise<void>, promise::budgeted<Clock> {
+		using promise::budgeted<Clock>::initial_suspend;
+
+		#if !defined(__cpp_explicit_this_parameter) ||  __cpp_explicit_this_parameter < 202110L // explicit object member functions not available
+			auto get_return_object(){ return promise::base::get_return_object(*this); }
+		#endif
+	};
+
+	template<class Clock = std::chrono::steady_clock>
+	unique_coroutine<budgeted_promise<Clock>> busy_loop(std::vector<int>& trace, int id, int iterations){
+		for(int i = 0; i < iterations; ++i){
+			trace.push_back(id);
+			co_await await::yield_if_budget_exhausted{};
+		}
+	}
+
+	simple_generator<int> numbers(int n){
+		for(int i = 0; i < n; ++i){ co_yield i; }
+	}
+
+	/* generators cannot be budgeted themselves, so the checkpoints go in the loop consuming them */
+	unique_coroutine<budgeted_promise<>> consume(std::vector<int>& trace, simple_generator<int> values){
+		for(int x : yield_range{std::move(values)}){
+			trace.push_back(x);
+			co_await await::yield_if_budget_exhausted{};
+		}
+	}
+
+	struct manual_clock {
+		using rep = std::int64_t;
+		using period = std::nano;
+		using duration = std::chrono::nanoseconds;
+		using time_point = std::chrono::time_point<manual_clock>;
+		static constexpr bool is_steady = true;
+
+		static inline time_point current{};
+
+		static time_point now() noexcept { return current += 3ns; }
+	};
+
+	procedure coalesced_request(
+		simulation_executor& exec, shared_task<int> fetch, duration arrival, std::vector<duration>& latencies, int& sum
+	){
+		co_await exec.sleep_for(arrival);
+		auto start = exec.now();
+		sum += co_await fetch.via(exec);
+		latencies.push_back(exec.now() - start);
+	}
+}
+
+TEST(SimulationTest, VirtualClock){
+	simulation_executor exec{};
+	std::vector<int> order;
+	exec.post_after(30ms, [&]{ order.push_back(3); });
+	exec.post_after(10ms, [&]{ order.push_back(1); });
+	exec.post_after(20ms, [&]{ order.push_back(2); });
+
+	EXPECT_EQ(exec.run_until(15ms), 1);
+	EXPECT_EQ(exec.now(), 15ms);
+	EXPECT_EQ(exec.run(), 2);
+	EXPECT_EQ(exec.now(), 30ms);
+	EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+	EXPECT_TRUE(exec.idle());
+}
+
+TEST(SimulationTest, ReproducibleInterleaving){
+	auto fifo = [](){
+		simulation_executor exec{0, simulation_executor::policy::fifo};
+		std::vector<int> trace;
+		for(int id = 0; id < 8; ++id){ exec.post([&, id]{ interleave_worker(exec, trace, id, 8); }); }
+		exec.run();
+		return trace;
+	}();
+
+	std::vector<int> round_robin;
+	for(int i = 0; i < 8; ++i){ for(int id = 0; id < 8; ++id){ round_robin.push_back(id); } }
+	EXPECT_EQ(fifo, round_robin);
+
+	bool permuted = false;
+	for(std::uint64_t seed = 1; seed <= 64; ++seed){
+		auto trace = interleave(seed);
+		ASSERT_EQ(trace, interleave(seed)) << "seed " << seed;
+		ASSERT_EQ(std::count(trace.begin(), trace.end(), 0), 8) << "seed " << seed;
+		permuted = permuted || trace != round_robin;
+	}
+	EXPECT_TRUE(permuted);
+}
+
+TEST(SimulationTest, BarrierStress){
+	duration longest{};
+	for(int i = 0; i < 256; ++i){ longest = std::max(longest, stress_delay(i)); }
+
+	std::vector<std::vector<int>> orders;
+	for(std::uint64_t seed = 0; seed < 64; ++seed){
+		simulation_executor exec{seed};
+		std::vector<int> completed;
+		duration finished{};
+		barrier_stress(exec, completed, finished, 256);
+		exec.run();
+
+		ASSERT_EQ(completed.size(), 256) << "seed " << seed;
+		ASSERT_EQ(finished, longest) << "seed " << seed;
+		for(std::size_t i = 1; i < completed.size(); ++i){
+			ASSERT_LE(stress_delay(completed[i - 1]), stress_delay(completed[i])) << "seed " << seed;
+		}
+		orders.push_back(std::move(completed));
+	}
+
+	std::sort(orders.begin(), orders.end());
+	EXPECT_EQ(std::unique(orders.begin(), orders.end()) - orders.begin(), 64);
+}
+
+TEST(SimulationTest, SharedTaskCoalescing){
+	for(std::uint64_t seed = 0; seed < 64; ++seed){
+		simulation_executor exec{seed};
+		int fetches = 0, sum = 0;
+		std::vector<duration> latencies;
+		{
+			auto fetch = backend_fetch(exec, fetches);
+			for(int i = 0; i < 32; ++i){ coalesced_request(exec, fetch, i * 1ms, latencies, sum); }
+		}
+		exec.run();
+
+		ASSERT_EQ(fetches, 1) << "seed " << seed;
+		ASSERT_EQ(sum, 32 * 42) << "seed " << seed;
+		ASSERT_EQ(latencies.size(), 32) << "seed " << seed;
+
+		// the first request starts the fetch at t=0, so no request waits longer than the fetch itself
+		std::sort(latencies.begin(), latencies.end());
+		ASSERT_EQ(latencies.back(), 10ms) << "seed " << seed;
+		ASSERT_EQ(latencies.front(), 0ms) << "seed " << seed;
+	}
+}
+
+TEST(SimulationTest, BudgetedTimeSlicing){
+	simulation_executor exec{0, simulation_executor::policy::fifo};
+	std::vector<int> trace, expected{1, 1, 1, 2, 1, 1, 1, 2, 1, 1};
+
+	auto heavy = busy_loop(trace, 1, 8);
+	heavy.promise().set_budget(3);
+	heavy.promise().schedule_on(exec);
+
+	auto light = busy_loop(trace, 2, 2);
+	light.promise().set_budget(1);
+	light.promise().schedule_on(exec);
+
+	exec(heavy.get());
+	exec(light.get());
+	exec.run();
+
+	EXPECT_EQ(trace, expected);
+	EXPECT_TRUE(heavy.done());
+	EXPECT_TRUE(light.done());
+	EXPECT_EQ(heavy.promise().usage().checkpoints, 8);
+	EXPECT_EQ(heavy.promise().usage().slices, 2);
+	EXPECT_EQ(light.promise().usage().slices, 2);
+}
+
+TEST(SimulationTest, BudgetedGeneratorConsumer){
+	simulation_executor exec{0, simulation_executor::policy::fifo};
+	std::vector<int> trace, expected{0, 1, 100, 2, 3, 100, 4, 5};
+
+	auto consumer = consume(trace, numbers(6));
+	consumer.promise().set_budget(2);
+	consumer.promise().schedule_on(exec);
+
+	auto light = busy_loop(trace, 100, 2);
+	light.promise().set_budget(1);
+	light.promise().schedule_on(exec);
+
+	exec(consumer.get());
+	exec(light.get());
+	exec.run();
+
+	// every value is read once & in order, with the generator only ever resumed by its consumer
+	EXPECT_EQ(trace, expected);
+	EXPECT_TRUE(consumer.done());
+	EXPECT_TRUE(exec.idle());
+	EXPECT_EQ(consumer.promise().usage().slices, 3);
+}
+
+TEST(SimulationTest, BudgetedElapsedTime){
+	std::vector<int> trace;
+	auto task = busy_loop<manual_clock>(trace, 1, 8);
+	task.promise().set_budget(std::numeric_limits<std::size_t>::max(), 10ns);
+	task();
+
+	// the clock advances 3ns per read: each slice starts on resumption & ends on its 4th checkpoint, 12ns later
+	EXPECT_TRUE(task.done());
+	EXPECT_EQ(trace.size(), 8);
+	EXPECT_EQ(task.promise().usage().slices, 2);
+	EXPECT_EQ(task.promise().usage().elapsed, 24ns);
+}
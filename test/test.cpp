@@ -3,6 +3,8 @@
 #ifndef QUASAR_CORO_MODULES
 	#include <quasar/coro/barrier.hpp>
 	#include <quasar/coro/coroutine.hpp>
+	#include <quasar/coro/profile.hpp>
+	#include <quasar/coro/shared.hpp>
 	#include <quasar/coro/yield.hpp>
 
 #else
@@ -11,6 +13,9 @@
 
 #endif
 
+#include <sstream>
+#include <stdexcept>
+
 using namespace quasar::coro;
 
 namespace {
@@ -74,6 +79,82 @@ namespace {
 		output.push_back(co_await await::callback<int>{dispatcher_await<int>, dispatcher});
 		output.push_back(3);
 	}
+
+	shared_task<int> shared_fetch(std::vector<int>& output, function_dispatcher<int>& dispatcher){
+		output.push_back(1);
+		co_return co_await await::callback<int>{&function_dispatcher<int>::await, dispatcher};
+	}
+
+	procedure shared_waiter(std::vector<int>& output, shared_task<int> task){
+		int const& value = co_await task;
+		output.push_back(value);
+	}
+
+	struct queue_executor {
+		std::vector<std::coroutine_handle<void>> queue{};
+
+		void operator ()(std::coroutine_handle<void> task){ queue.push_back(task); }
+	};
+
+	struct profiled_promise : task_promise<void>, promise::profiled<profiled_promise> {
+		static constexpr std::string_view frame_name = "profiled_promise";
+
+		using promise::profiled<profiled_promise>::operator new;
+		using promise::profiled<profiled_promise>::operator delete;
+
+		#if !defined(__cpp_explicit_this_parameter) ||  __cpp_explicit_this_parameter < 202110L // explicit object member functions not available
+			auto get_return_object(){ return promise::base::get_return_object(*this); }
+		#endif
+	};
+
+	unique_coroutine<profiled_promise> profiled_frame(std::size_t padding){
+		std::vector<char> local(padding);
+		co_await std::suspend_always{};
+	}
+
+	struct counting_allocator {
+		static inline std::size_t allocations = 0;
+
+		static void* operator new(std::size_t size){
+			++allocations;
+			return ::operator new(size);
+		}
+
+		static void operator delete(void* frame, std::size_t size) noexcept { ::operator delete(frame, size); }
+	};
+
+	// the common promises declare no allocation functions of their own, unless profiled
+	struct pooled_promise : task_promise<void>, counting_allocator {
+		#ifdef QUASAR_CORO_PROFILE_FRAMES
+			using counting_allocator::operator new;
+			using counting_allocator::operator delete;
+		#endif
+
+		#if !defined(__cpp_explicit_this_parameter) ||  __cpp_explicit_this_parameter < 202110L // explicit object member functions not available
+			auto get_return_object(){ return promise::base::get_return_object(*this); }
+		#endif
+	};
+
+	unique_coroutine<pooled_promise> pooled_frame(){ co_return; }
+
+	simple_generator<int> count(int first, int n){
+		for(int i = 0; i < n; ++i){ co_yield first + i; }
+	}
+
+	generator<int> nested_count(){
+		co_yield 1;
+		co_yield count(2, 2);
+		co_yield 4;
+	}
+
+	// the iterator destroys the producers it owns, which must therefore pause at their final suspend point
+	template<class Producer> constexpr bool preemptable = requires(yield_iterator<int>& itr, Producer task){ itr.preempt(task); };
+	static_assert(preemptable<coroutine<simple_generator_promise<int, void>>>);
+	static_assert(!preemptable<procedure>);
+
+	procedure shared_waiter_via(std::vector<int>& output, shared_task<int> task, queue_executor& exec){
+		output.push_back(co_await task.via(exec));
+	}
 }
 
 TEST(AwaiterTest, SimpleDelegate){
@@ -117,3 +198,121 @@ TEST(AwaiterTest, Callback){
 	dispatcher.func(12);
 	EXPECT_EQ(checkpoints, expected);
 }
+
+TEST(AwaiterTest, SharedTask){
+	std::vector<int> checkpoints, expected{1, 11, 11, 11};
+	function_dispatcher<int> dispatcher;
+	{
+		auto task = shared_fetch(checkpoints, dispatcher);
+		shared_waiter(checkpoints, task);
+		shared_waiter(checkpoints, task);
+		dispatcher.func(11);
+		EXPECT_TRUE(task.done());
+		shared_waiter(checkpoints, task); // already complete: resumes without suspending
+	}
+	EXPECT_EQ(checkpoints, expected);
+}
+
+TEST(AwaiterTest, SharedTaskVia){
+	std::vector<int> checkpoints, expected{1, 11};
+	function_dispatcher<int> dispatcher;
+	queue_executor exec;
+
+	auto task = shared_fetch(checkpoints, dispatcher);
+	shared_waiter_via(checkpoints, task, exec);
+	dispatcher.func(11);
+	EXPECT_EQ(checkpoints.size(), 1);
+	ASSERT_EQ(exec.queue.size(), 1);
+	exec.queue.front().resume();
+	EXPECT_EQ(checkpoints, expected);
+
+	// the executor is still used once the task has completed
+	shared_waiter_via(checkpoints, task, exec);
+	EXPECT_EQ(checkpoints.size(), 2);
+	ASSERT_EQ(exec.queue.size(), 2);
+	exec.queue.back().resume();
+	EXPECT_EQ(checkpoints, (std::vector<int>{1, 11, 11}));
+	EXPECT_TRUE(shared_task<int>{}.done());
+}
+
+TEST(ProfileTest, CustomAllocation){
+	auto before = counting_allocator::allocations;
+	{ auto task = pooled_frame(); }
+	EXPECT_EQ(counting_allocator::allocations, before + 1);
+}
+
+TEST(ProfileTest, FrameCounters){
+	{
+		auto a = profiled_frame(1), b = profiled_frame(2);
+		auto stats = frame_profile::of<profiled_promise>();
+		EXPECT_EQ(stats.name, "profiled_promise");
+		EXPECT_EQ(stats.allocations, 2);
+		EXPECT_EQ(stats.live, 2);
+		EXPECT_EQ(stats.live_bytes, 2 * stats.largest_frame);
+		EXPECT_EQ(stats.peak_live_bytes, stats.live_bytes);
+	}
+
+	auto stats = frame_profile::of<profiled_promise>();
+	EXPECT_EQ(stats.live, 0);
+	EXPECT_EQ(stats.live_bytes, 0);
+	EXPECT_EQ(stats.peak_live_bytes, 2 * stats.largest_frame);
+
+	std::ostringstream table;
+	frame_profile::dump(table);
+	EXPECT_NE(table.str().find("profiled_promise"), std::string::npos);
+
+	// reading a type that never allocated must not register it
+	struct idle_promise {};
+	EXPECT_EQ(frame_profile::of<idle_promise>().allocations, 0);
+	for(auto const& row : frame_profile::snapshot()){ EXPECT_EQ(row.name.find("idle_promise"), std::string_view::npos); }
+}
+
+TEST(GeneratorTest, Delegate){
+	std::vector<int> values, expected{1, 2, 3, 4};
+	for(int x : yield_range{nested_count()}){ values.push_back(x); }
+	EXPECT_EQ(values, expected);
+}
+
+TEST(GeneratorTest, Preempt){
+	std::vector<int> values, expected{1, 2, 100, 101, 3, 4};
+	auto task = nested_count();
+	for(yield_iterator<int> itr{task}; itr != std::default_sentinel; ++itr){
+		values.push_back(*itr);
+		if(*itr == 2){ itr.preempt(count(100, 2).release()); }
+	}
+	EXPECT_EQ(values, expected);
+}
+
+TEST(GeneratorTest, PriorityStream){
+	std::vector<int> values, expected{20, 21, 10, 30, 1, 2, 3, 4, 11, 12, 40};
+	priority_stream<int> stream;
+	stream.push(count(10, 3));
+	stream.push(count(20, 2), 1);
+
+	for(int x : stream){
+		values.push_back(x);
+		if(x == 10){
+			stream.push(count(40, 1), 0);  // same priority as the running producer: queued behind it
+			stream.push(count(30, 1), 5);  // preempts right away
+			stream.push(nested_count(), 2); // runs once the preemptor is done
+		}
+	}
+	EXPECT_EQ(values, expected);
+}
+
+TEST(GeneratorTest, PriorityStreamDepth){
+	priority_stream<int, 1> stream;
+	stream.push(count(10, 1));
+	stream.push(count(20, 1), 1);
+
+	auto overflow = count(30, 1);
+	EXPECT_THROW(stream.push(std::move(overflow), 2), std::length_error);
+	EXPECT_TRUE(overflow); // ownership is not taken when the stream is full
+
+	// delegating producers link to the depth-independent base, so any depth can iterate them
+	std::vector<int> values, expected{1, 2, 3, 4};
+	priority_stream<int, 2> nested;
+	nested.push(nested_count());
+	for(int x : nested){ values.push_back(x); }
+	EXPECT_EQ(values, expected);
+}